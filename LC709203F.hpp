@@ -9,6 +9,9 @@
  * file:        LC709203F.hpp
  */
 
+#ifndef LC709203F_HPP
+#define LC709203F_HPP
+
 #include <cinttypes>
 
 /* Derive from class LC709203F_Base and implement the read and write functions! */
@@ -731,3 +734,5 @@ public:
 	}
 	
 };
+
+#endif
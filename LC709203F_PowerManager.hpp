@@ -0,0 +1,342 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        LC709203F_PowerManager.hpp
+ */
+
+#ifndef LC709203F_POWERMANAGER_HPP
+#define LC709203F_POWERMANAGER_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+#include "LC709203F.hpp"
+
+/* Derive from class LC709203F_PowerManager::Reader and implement the completed function! */
+
+/*
+ * LC709203F_PowerManager: Sleep/Operational duty cycling through IC_POWER_MODE.
+ * Tracks the device's power mode so no mode switch is issued twice, and queues non-urgent reads
+ * until the next wake window. Urgent reads go through readNow().
+ *
+ * A wake window is opened by beginWindow(), which switches to Operational_Mode, and closed by
+ * endWindow(), which reads every queued register in one burst (one bus read per distinct register)
+ * and returns the device to Sleep_Mode. The gauge does not measure while asleep, so endWindow()
+ * refuses to run before the settle time given to setSettle() has passed since beginWindow(); in
+ * that time the device takes a fresh measurement. The settle time depends on the application and
+ * defaults to 0. Time stamps are in caller defined ticks (e.g. ms).
+ */
+class LC709203F_PowerManager
+{
+public:
+	/* Pure virtual function that needs to be implemented in derived class: */
+	class Reader
+	{
+	public:
+		virtual ~Reader() {}
+		virtual void completed(uint16_t address, uint16_t value) = 0;
+	};
+
+	struct Metrics
+	{
+		uint32_t bus_transactions; // Register reads plus mode switches
+		uint32_t mode_switches;    // Writes to IC_POWER_MODE
+		uint32_t samples;          // Values delivered to readers plus values returned by readNow()
+		uint32_t wake_windows;     // Wake windows that touched the bus
+		uint64_t latency_total;    // Sum of queue-to-delivery latency in ticks
+		uint64_t latency_max;      // Largest queue-to-delivery latency in ticks
+		uint64_t wake_total;       // Sum of beginWindow() to endWindow() time in ticks
+		uint64_t wake_max;         // Largest beginWindow() to endWindow() time in ticks
+
+		Metrics()
+			: bus_transactions(0), mode_switches(0), samples(0), wake_windows(0), latency_total(0), latency_max(0),
+			  wake_total(0), wake_max(0)
+		{
+		}
+
+		/* Bus transactions per delivered sample */
+		double transactionsPerSample() const
+		{
+			return samples ? (double)bus_transactions / samples : 0.0;
+		}
+
+		/* Average queue-to-delivery latency in ticks */
+		double averageLatency() const
+		{
+			return samples ? (double)latency_total / samples : 0.0;
+		}
+
+		/* Average wake latency of a window in ticks */
+		double averageWake() const
+		{
+			return wake_windows ? (double)wake_total / wake_windows : 0.0;
+		}
+	};
+
+	/* Reads the current power mode from the device */
+	explicit LC709203F_PowerManager(LC709203F_Base &device)
+		: device(device), mode(0), settle(0), window_open(false), window_start(0),
+		  awake_since(0), awake_timed(false), awake_settled(false)
+	{
+		syncMode();
+	}
+
+	/*
+	 * Minimum time in ticks between waking the device and trusting its values: the burst in
+	 * endWindow() waits this long after beginWindow(), and readNow() only shares its value with
+	 * queued requests once the device has been operational this long.
+	 */
+	void setSettle(uint32_t ticks)
+	{
+		settle = ticks;
+	}
+
+	/*
+	 * Re-read the power mode from the device, e.g. after a reset. A device found operational is
+	 * assumed to have been measuring for longer than the settle time.
+	 */
+	uint16_t syncMode()
+	{
+		mode = device.getIC_POWER_MODE();
+		metrics.bus_transactions++;
+		awake_timed = false;
+		awake_settled = (mode == LC709203F_Base::IC_POWER_MODE::Operational_Mode);
+		return mode;
+	}
+
+	uint16_t getMode() const
+	{
+		return mode;
+	}
+
+	bool isSleeping() const
+	{
+		return mode == LC709203F_Base::IC_POWER_MODE::Sleep_Mode;
+	}
+
+	/* Switch power mode; does nothing when the device already is in that mode */
+	void setMode(uint16_t value)
+	{
+		if (mode == value)
+			return;
+		device.setIC_POWER_MODE(value);
+		mode = value;
+		awake_timed = false;
+		awake_settled = false;
+		metrics.mode_switches++;
+		metrics.bus_transactions++;
+	}
+
+	void sleep()
+	{
+		setMode(LC709203F_Base::IC_POWER_MODE::Sleep_Mode);
+	}
+
+	void wake()
+	{
+		setMode(LC709203F_Base::IC_POWER_MODE::Operational_Mode);
+	}
+
+	/* Queue a non-urgent read of register address with width n (8 or 16 bit) */
+	void queue(uint16_t address, uint16_t n, Reader *reader, uint32_t now)
+	{
+		if (reader == 0)
+			return;
+
+		Request r;
+		r.address = address;
+		r.n = n;
+		r.reader = reader;
+		r.queued = now;
+		pending.push_back(r);
+	}
+
+	size_t queued() const
+	{
+		return pending.size();
+	}
+
+	/*
+	 * Urgent read: wakes the device if needed, reads address and restores the previous power mode.
+	 * A device woken just for this read returns values from before it went to sleep, so queued
+	 * requests are left for endWindow() unless the device has been operational for the settle time.
+	 * In that case the value is also delivered to queued requests for the same register, and outside
+	 * a window the other queued requests are served in the same wake.
+	 */
+	uint16_t readNow(uint16_t address, uint16_t n, uint32_t now)
+	{
+		bool fresh = settled(now);
+		uint16_t previous = mode;
+		wake();
+		uint16_t value = read(address, n);
+		metrics.samples++;
+		if (fresh)
+		{
+			share(address, n, value, now);
+			if (!window_open)
+				burst(now);
+		}
+		setMode(previous);
+		return value;
+	}
+
+	/* Open a wake window if reads are queued. Returns true if the window was opened */
+	bool beginWindow(uint32_t now)
+	{
+		if (window_open)
+			return true;
+		if (pending.empty())
+			return false;
+
+		wake();
+		settled(now);
+		window_open = true;
+		window_start = now;
+		return true;
+	}
+
+	/* True once the settle time of an open window has passed */
+	bool windowReady(uint32_t now) const
+	{
+		return window_open && (uint32_t)(now - window_start) >= settle;
+	}
+
+	/*
+	 * Close the wake window: run the queued reads as one burst and return the device to sleep.
+	 * Does nothing before windowReady(). Returns the number of bus reads issued.
+	 */
+	size_t endWindow(uint32_t now)
+	{
+		if (!windowReady(now))
+			return 0;
+
+		uint32_t elapsed = now - window_start;
+		metrics.wake_windows++;
+		metrics.wake_total += elapsed;
+		if (elapsed > metrics.wake_max)
+			metrics.wake_max = elapsed;
+
+		size_t reads = burst(now);
+		sleep();
+		window_open = false;
+		return reads;
+	}
+
+	const Metrics &getMetrics() const
+	{
+		return metrics;
+	}
+
+	void resetMetrics()
+	{
+		metrics = Metrics();
+	}
+
+private:
+	struct Request
+	{
+		uint16_t address;
+		uint16_t n;
+		Reader *reader;
+		uint32_t queued;
+	};
+
+	/*
+	 * True once the device has been operational for the settle time. The first call after an
+	 * untimed mode switch starts the clock.
+	 */
+	bool settled(uint32_t now)
+	{
+		if (mode != LC709203F_Base::IC_POWER_MODE::Operational_Mode)
+			return false;
+		if (!awake_settled)
+		{
+			if (!awake_timed)
+			{
+				awake_since = now;
+				awake_timed = true;
+			}
+			awake_settled = (uint32_t)(now - awake_since) >= settle;
+		}
+		return awake_settled;
+	}
+
+	uint16_t read(uint16_t address, uint16_t n)
+	{
+		metrics.bus_transactions++;
+		return (n == 8) ? device.read8(address, 8) : device.read16(address, 16);
+	}
+
+	/* Deliver an already read value to the queued requests for the same register */
+	void share(uint16_t address, uint16_t n, uint16_t value, uint32_t now)
+	{
+		std::vector<Request> matching;
+		size_t kept = 0;
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			if (pending[i].address == address && pending[i].n == n)
+				matching.push_back(pending[i]);
+			else
+				pending[kept++] = pending[i];
+		}
+		pending.resize(kept);
+
+		for (size_t i = 0; i < matching.size(); i++)
+			deliver(matching[i], value, now);
+	}
+
+	/* Serve all queued requests, reading each distinct register once */
+	size_t burst(uint32_t now)
+	{
+		/* Readers may queue again from completed(), those requests wait for the next window */
+		std::vector<Request> batch;
+		batch.swap(pending);
+
+		std::vector<bool> done(batch.size(), false);
+		size_t reads = 0;
+		for (size_t i = 0; i < batch.size(); i++)
+		{
+			if (done[i])
+				continue;
+
+			uint16_t value = read(batch[i].address, batch[i].n);
+			reads++;
+			for (size_t j = i; j < batch.size(); j++)
+			{
+				if (done[j] || batch[j].address != batch[i].address || batch[j].n != batch[i].n)
+					continue;
+				done[j] = true;
+				deliver(batch[j], value, now);
+			}
+		}
+		return reads;
+	}
+
+	void deliver(const Request &r, uint16_t value, uint32_t now)
+	{
+		uint32_t latency = now - r.queued;
+		metrics.samples++;
+		metrics.latency_total += latency;
+		if (latency > metrics.latency_max)
+			metrics.latency_max = latency;
+		r.reader->completed(r.address, value);
+	}
+
+	LC709203F_Base &device;
+	uint16_t mode;
+	uint32_t settle;
+	bool window_open;
+	uint32_t window_start;
+	uint32_t awake_since;
+	bool awake_timed;
+	bool awake_settled;
+	std::vector<Request> pending;
+	Metrics metrics;
+};
+
+#endif
@@ -0,0 +1,433 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        LC709203F_Scheduler.hpp
+ */
+
+#ifndef LC709203F_SCHEDULER_HPP
+#define LC709203F_SCHEDULER_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <cerrno>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "LC709203F.hpp"
+
+/* Derive from class LC709203F_Scheduler::Dispatcher and implement the dispatch function! */
+
+/*
+ * LC709203F_Scheduler: single threaded deadline scheduler for many gauges (Linux only).
+ * Jobs are kept in a binary min-heap ordered by deadline; one timerfd, armed with an absolute
+ * CLOCK_MONOTONIC deadline of the heap top, wakes an epoll loop. All jobs due within the coalescing
+ * window are popped together, grouped by bus and handed to the Dispatcher as one batch per bus.
+ * Next deadlines are computed from the previous deadline, not from the wakeup time, so sample
+ * timing does not drift; periods missed entirely are skipped and counted.
+ * The epoll descriptor is exposed by fd() so the scheduler can be nested into another event loop.
+ */
+class LC709203F_Scheduler
+{
+public:
+	/* A job that fell due, as handed to the dispatcher */
+	struct Due
+	{
+		LC709203F_Base *gauge;
+		void *context;
+		uint64_t deadline; // Scheduled time in ns of CLOCK_MONOTONIC
+	};
+
+	/* Pure virtual function that needs to be implemented in derived class: */
+	class Dispatcher
+	{
+	public:
+		virtual ~Dispatcher() {}
+		virtual void dispatch(uint16_t bus, const Due *due, size_t n) = 0;
+	};
+
+	/*
+	 * Handle returned by add(), used to remove. Carries the slot in the low 32 bits and the slot's
+	 * generation in the high 32 bits, so a stale handle never removes a reused slot.
+	 */
+	typedef uint64_t Handle;
+	static const Handle INVALID_HANDLE = ~(uint64_t)0;
+
+	struct Metrics
+	{
+		uint64_t wakeups;     // Timer expirations handled
+		uint64_t jobs;        // Jobs dispatched
+		uint64_t batches;     // Dispatcher calls (one per bus per wakeup)
+		uint64_t missed;      // Periods skipped because a job overran a full interval
+		uint64_t lateness_max; // Largest delay in ns between deadline and dispatch
+
+		Metrics()
+			: wakeups(0), jobs(0), batches(0), missed(0), lateness_max(0)
+		{
+		}
+	};
+
+	/* coalesce_ns: jobs due within this window after the earliest one are dispatched together */
+	explicit LC709203F_Scheduler(Dispatcher &dispatcher, uint64_t coalesce_ns=0)
+		: dispatcher(dispatcher), coalesce(coalesce_ns), running(false), timer_failed(false), epoll_fd(-1), timer_fd(-1),
+		  stale_entries(0)
+	{
+		timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (timer_fd < 0 || epoll_fd < 0)
+			return;
+
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = timer_fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0)
+		{
+			close(epoll_fd);
+			epoll_fd = -1;
+		}
+	}
+
+	~LC709203F_Scheduler()
+	{
+		if (epoll_fd >= 0)
+			close(epoll_fd);
+		if (timer_fd >= 0)
+			close(timer_fd);
+	}
+
+	/* False if the timerfd or epoll descriptor could not be created */
+	bool isOpen() const
+	{
+		return epoll_fd >= 0 && timer_fd >= 0;
+	}
+
+	int fd() const
+	{
+		return epoll_fd;
+	}
+
+	/* Current time in ns of CLOCK_MONOTONIC, the time base of all deadlines */
+	static uint64_t now()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+	}
+
+	/*
+	 * Schedule gauge on bus every interval_ns, first at time start (0 = now). Gauges sharing a bus id
+	 * are coalesced into one dispatch when they fall due together.
+	 */
+	Handle add(LC709203F_Base *gauge, uint16_t bus, uint64_t interval_ns, void *context=0, uint64_t start=0)
+	{
+		if (interval_ns == 0)
+			return INVALID_HANDLE;
+
+		Job job;
+		job.gauge = gauge;
+		job.context = context;
+		job.bus = bus;
+		job.interval = interval_ns;
+		job.generation = 0;
+		job.active = true;
+
+		size_t slot;
+		if (!free_jobs.empty())
+		{
+			slot = free_jobs.back();
+			free_jobs.pop_back();
+			job.generation = jobs[slot].generation + 1;
+			jobs[slot] = job;
+		}
+		else
+		{
+			slot = jobs.size();
+			jobs.push_back(job);
+		}
+
+		/* Only touch the timer when the new job becomes the earliest deadline */
+		push(start ? start : now(), slot);
+		if (heap.front().slot == slot && heap.front().generation == job.generation)
+			arm();
+		return ((uint64_t)job.generation << 32) | (uint64_t)slot;
+	}
+
+	/*
+	 * Unschedule a job. Its heap entry is discarded lazily when it comes due; once such stale
+	 * entries outnumber the live jobs the heap is rebuilt, so it stays below twice size().
+	 */
+	void remove(Handle handle)
+	{
+		size_t slot = (size_t)(handle & 0xffffffffu);
+		uint32_t generation = (uint32_t)(handle >> 32);
+		if (slot >= jobs.size() || !jobs[slot].active || jobs[slot].generation != generation)
+			return;
+
+		jobs[slot].active = false;
+		jobs[slot].generation++;
+		free_jobs.push_back(slot);
+
+		stale_entries++;
+		if (stale_entries > size())
+			compact();
+	}
+
+	size_t size() const
+	{
+		return jobs.size() - free_jobs.size();
+	}
+
+	/* Number of heap entries, including lazily removed ones */
+	size_t entries() const
+	{
+		return heap.size();
+	}
+
+	/*
+	 * Wait up to timeout_ms (-1 = forever) for due jobs and dispatch them.
+	 * Returns the number of jobs dispatched, or -1 on error, including a timerfd that could not be
+	 * armed (the loop would otherwise block forever).
+	 */
+	int runOnce(int timeout_ms=-1)
+	{
+		if (!isOpen())
+			return -1;
+		if (timer_failed && !arm())
+			return -1;
+
+		struct epoll_event ev;
+		int n = epoll_wait(epoll_fd, &ev, 1, timeout_ms);
+		if (n < 0)
+			return (errno == EINTR) ? 0 : -1;
+		if (n == 0)
+			return 0;
+
+		uint64_t expirations;
+		if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+			return -1;
+
+		metrics.wakeups++;
+		int dispatched = (int)expire(now());
+		if (!arm())
+			return -1;
+		return dispatched;
+	}
+
+	/* Run until stop() is called, e.g. from a dispatcher. Returns false on error */
+	bool run()
+	{
+		running = true;
+		while (running)
+		{
+			if (runOnce() < 0)
+			{
+				running = false;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void stop()
+	{
+		running = false;
+	}
+
+	const Metrics &getMetrics() const
+	{
+		return metrics;
+	}
+
+private:
+	/* Owns the descriptors, not copyable */
+	LC709203F_Scheduler(const LC709203F_Scheduler &);
+	LC709203F_Scheduler &operator=(const LC709203F_Scheduler &);
+
+	struct Job
+	{
+		LC709203F_Base *gauge;
+		void *context;
+		uint16_t bus;
+		uint64_t interval;
+		uint32_t generation;
+		bool active;
+	};
+
+	struct Entry
+	{
+		uint64_t deadline;
+		size_t slot;
+		uint32_t generation;
+	};
+
+	/* Min-heap order on deadline for std::push_heap/std::pop_heap */
+	struct Later
+	{
+		bool operator()(const Entry &a, const Entry &b) const
+		{
+			return a.deadline > b.deadline;
+		}
+	};
+
+	/* Order of a due batch: by bus, then deadline */
+	struct ByBus
+	{
+		const std::vector<Job> *jobs;
+
+		bool operator()(const Entry &a, const Entry &b) const
+		{
+			uint16_t bus_a = (*jobs)[a.slot].bus;
+			uint16_t bus_b = (*jobs)[b.slot].bus;
+			if (bus_a != bus_b)
+				return bus_a < bus_b;
+			return a.deadline < b.deadline;
+		}
+	};
+
+	void push(uint64_t deadline, size_t slot)
+	{
+		Entry e;
+		e.deadline = deadline;
+		e.slot = slot;
+		e.generation = jobs[slot].generation;
+		heap.push_back(e);
+		std::push_heap(heap.begin(), heap.end(), Later());
+	}
+
+	bool stale(const Entry &e) const
+	{
+		return !jobs[e.slot].active || jobs[e.slot].generation != e.generation;
+	}
+
+	/* Drop all stale entries and restore the heap order */
+	void compact()
+	{
+		size_t kept = 0;
+		for (size_t i = 0; i < heap.size(); i++)
+			if (!stale(heap[i]))
+				heap[kept++] = heap[i];
+		heap.resize(kept);
+		std::make_heap(heap.begin(), heap.end(), Later());
+		stale_entries = 0;
+	}
+
+	/*
+	 * Arm the timerfd for the earliest live deadline, or disarm it when idle.
+	 * Returns false if timerfd_settime() failed; runOnce() reports that as an error.
+	 */
+	bool arm()
+	{
+		while (!heap.empty() && stale(heap.front()))
+		{
+			std::pop_heap(heap.begin(), heap.end(), Later());
+			heap.pop_back();
+			stale_entries--;
+		}
+
+		struct itimerspec its;
+		its.it_interval.tv_sec = 0;
+		its.it_interval.tv_nsec = 0;
+		its.it_value.tv_sec = 0;
+		its.it_value.tv_nsec = 0;
+		if (!heap.empty())
+		{
+			/* An all-zero it_value disarms the timer, so never arm for time 0 */
+			uint64_t deadline = heap.front().deadline ? heap.front().deadline : 1;
+			its.it_value.tv_sec = deadline / 1000000000ull;
+			its.it_value.tv_nsec = deadline % 1000000000ull;
+		}
+		timer_failed = timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, 0) < 0;
+		return !timer_failed;
+	}
+
+	/* Pop everything due by t (plus coalescing window), dispatch per bus and reschedule */
+	size_t expire(uint64_t t)
+	{
+		due_entries.clear();
+		uint64_t limit = t + coalesce;
+		while (!heap.empty() && heap.front().deadline <= limit)
+		{
+			Entry e = heap.front();
+			std::pop_heap(heap.begin(), heap.end(), Later());
+			heap.pop_back();
+			if (stale(e))
+				stale_entries--;
+			else
+				due_entries.push_back(e);
+		}
+		if (due_entries.empty())
+			return 0;
+
+		/* Reschedule before dispatching so dispatchers may remove or add jobs */
+		for (size_t i = 0; i < due_entries.size(); i++)
+		{
+			const Entry &e = due_entries[i];
+			uint64_t interval = jobs[e.slot].interval;
+			uint64_t next = e.deadline + interval;
+			if (next <= t)
+			{
+				uint64_t skipped = (t - next) / interval + 1;
+				metrics.missed += skipped;
+				next += skipped * interval;
+			}
+			push(next, e.slot);
+
+			if (t > e.deadline && t - e.deadline > metrics.lateness_max)
+				metrics.lateness_max = t - e.deadline;
+		}
+
+		ByBus by_bus;
+		by_bus.jobs = &jobs;
+		std::sort(due_entries.begin(), due_entries.end(), by_bus);
+
+		/* Copy out everything the dispatch loop needs, jobs may change under a dispatcher */
+		size_t count = due_entries.size();
+		batch.resize(count);
+		buses.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const Job &job = jobs[due_entries[i].slot];
+			batch[i].gauge = job.gauge;
+			batch[i].context = job.context;
+			batch[i].deadline = due_entries[i].deadline;
+			buses[i] = job.bus;
+		}
+
+		size_t start = 0;
+		for (size_t i = 1; i <= count; i++)
+		{
+			if (i < count && buses[i] == buses[start])
+				continue;
+			dispatcher.dispatch(buses[start], &batch[start], i - start);
+			metrics.batches++;
+			start = i;
+		}
+
+		metrics.jobs += count;
+		return count;
+	}
+
+	Dispatcher &dispatcher;
+	uint64_t coalesce;
+	bool running;
+	bool timer_failed;
+	int epoll_fd;
+	int timer_fd;
+	std::vector<Job> jobs;
+	std::vector<size_t> free_jobs;
+	std::vector<Entry> heap;
+	size_t stale_entries;
+	std::vector<Entry> due_entries;
+	std::vector<Due> batch;
+	std::vector<uint16_t> buses;
+	Metrics metrics;
+};
+
+#endif
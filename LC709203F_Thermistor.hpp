@@ -0,0 +1,225 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        LC709203F_Thermistor.hpp
+ */
+
+#ifndef LC709203F_THERMISTOR_HPP
+#define LC709203F_THERMISTOR_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <cmath>
+
+/*
+ * LC709203F_Thermistor: host side NTC conversion for I2C temperature mode (STATUS_BIT = I2C_MODE).
+ * Converts a thermistor reading to CELL_TEMPERATURE_I2C register units (0.1K) using the same
+ * B-constant that is programmed into THERMISTOR_B:
+ *   1/T = 1/T25 + ln(R/R25)/B
+ * Instead of calling log() per sample, the temperature is tabulated once per B-constant over the
+ * divider ratio a = R/(R+Rpullup), which maps the register range onto a bounded interval and makes
+ * the lookup a single multiply plus linear interpolation. Results are clamped to the register range
+ * 'h09E4 (-20°C) to 'h0D04 (+60°C).
+ */
+class LC709203F_Thermistor
+{
+public:
+	static const uint16_t MIN_TEMPERATURE = 0x09e4; // -20°C in 0.1K
+	static const uint16_t MAX_TEMPERATURE = 0x0d04; // +60°C in 0.1K
+	static const size_t SEGMENTS = 512; // Interpolation segments of the lookup table
+
+	/*
+	 * b_constant: thermistor B-constant in 1K, as written to THERMISTOR_B.
+	 * pullup_ratio: Rpullup/R25 of the divider feeding the ADC (thermistor on the low side).
+	 * Arguments refused by setB fall back to the THERMISTOR_B default 'hd34 with pullup_ratio 1.
+	 */
+	explicit LC709203F_Thermistor(uint16_t b_constant=0x0d34, double pullup_ratio=1.0)
+	{
+		build(0x0d34, 1.0);
+		if (b_constant != 0x0d34 || pullup_ratio != 1.0)
+			setB(b_constant, pullup_ratio);
+	}
+
+	/*
+	 * Rebuild the lookup table for another B-constant or divider.
+	 * Returns false and keeps the previous table if b_constant is 0, pullup_ratio is not positive, or
+	 * the interpolation error of the new table would exceed maxTableError() (½ LSB). Very large
+	 * B-constants, especially with a pullup far from R25, bend the curve too much for the table.
+	 */
+	bool setB(uint16_t b_constant, double pullup_ratio=1.0)
+	{
+		if (b_constant == 0 || !(pullup_ratio > 0))
+			return false;
+
+		LC709203F_Thermistor previous(*this);
+		build(b_constant, pullup_ratio);
+		if (!(maxError() <= maxTableError()))
+		{
+			*this = previous;
+			return false;
+		}
+		return true;
+	}
+
+	/* Largest interpolation error in 0.1K that setB() accepts for a table */
+	static double maxTableError()
+	{
+		return 0.5;
+	}
+
+	uint16_t getB() const
+	{
+		return b;
+	}
+
+	/* Convert a divider ratio a = R/(R+Rpullup), e.g. ADC counts / full scale */
+	uint16_t fromDivider(double a) const
+	{
+		if (!(a > a_min))
+			return MAX_TEMPERATURE;
+		if (!(a < a_max))
+			return MIN_TEMPERATURE;
+
+		return clamp(interpolate(a));
+	}
+
+	/* Convert a resistance ratio r = R/R25 */
+	uint16_t fromRatio(double r) const
+	{
+		if (!(r > 0))
+			return MAX_TEMPERATURE;
+		return fromDivider(r / (r + k));
+	}
+
+	/* Convert raw ADC counts of the divider */
+	uint16_t fromAdc(uint32_t counts, uint32_t full_scale) const
+	{
+		if (full_scale == 0)
+			return MAX_TEMPERATURE;
+		return fromDivider((double)counts / full_scale);
+	}
+
+	/* Batch conversions, out must hold n values */
+	void fromDivider(const double *a, uint16_t *out, size_t n) const
+	{
+		for (size_t i = 0; i < n; i++)
+			out[i] = fromDivider(a[i]);
+	}
+
+	void fromRatio(const double *r, uint16_t *out, size_t n) const
+	{
+		for (size_t i = 0; i < n; i++)
+			out[i] = fromRatio(r[i]);
+	}
+
+	void fromAdc(const uint32_t *counts, uint32_t full_scale, uint16_t *out, size_t n) const
+	{
+		if (full_scale == 0)
+		{
+			for (size_t i = 0; i < n; i++)
+				out[i] = MAX_TEMPERATURE;
+			return;
+		}
+
+		double inv = 1.0 / full_scale;
+		for (size_t i = 0; i < n; i++)
+			out[i] = fromDivider(counts[i] * inv);
+	}
+
+	/* Exact conversion of a resistance ratio with log(), for reference and verification */
+	uint16_t exactFromRatio(double r) const
+	{
+		if (!(r > 0))
+			return MAX_TEMPERATURE;
+		return clamp(exactDivider(r / (r + k)));
+	}
+
+	/*
+	 * Accuracy check against the exact formula: sweeps the divider ratio over the register range in
+	 * steps points and returns the largest deviation of the unrounded interpolated temperature, in
+	 * 0.1K register units. Rounding to the register adds up to another ½ LSB on top.
+	 */
+	double maxError(size_t steps=SEGMENTS * 8) const
+	{
+		double worst = 0;
+		for (size_t i = 0; i <= steps; i++)
+		{
+			double a = a_min + (a_max - a_min) * i / steps;
+			double error = std::fabs(interpolate(a) - exactDivider(a));
+			if (error != error)
+				return error;
+			if (error > worst)
+				worst = error;
+		}
+		return worst;
+	}
+
+private:
+	void build(uint16_t b_constant, double pullup_ratio)
+	{
+		b = b_constant;
+		k = pullup_ratio;
+
+		/* The table runs from the hot end (small ratio) to the cold end (large ratio) */
+		a_min = ratioToDivider(exactRatio(MAX_TEMPERATURE));
+		a_max = ratioToDivider(exactRatio(MIN_TEMPERATURE));
+		scale = SEGMENTS / (a_max - a_min);
+
+		for (size_t i = 0; i <= SEGMENTS; i++)
+		{
+			double a = a_min + (a_max - a_min) * i / SEGMENTS;
+			table[i] = exactDivider(a);
+		}
+	}
+
+	/* Interpolated temperature in 0.1K for divider ratio a within [a_min, a_max] */
+	double interpolate(double a) const
+	{
+		double x = (a - a_min) * scale;
+		size_t i = (x > 0) ? (size_t)x : 0;
+		if (i >= SEGMENTS)
+			i = SEGMENTS - 1;
+		return table[i] + (x - i) * (table[i + 1] - table[i]);
+	}
+
+	/* Temperature in 0.1K for divider ratio a */
+	double exactDivider(double a) const
+	{
+		double r = k * a / (1.0 - a);
+		return 10.0 / (1.0 / 298.15 + std::log(r) / b);
+	}
+
+	/* Resistance ratio R/R25 at temperature t in 0.1K */
+	double exactRatio(uint16_t t) const
+	{
+		return std::exp(b * (10.0 / t - 1.0 / 298.15));
+	}
+
+	double ratioToDivider(double r) const
+	{
+		return r / (r + k);
+	}
+
+	static uint16_t clamp(double t)
+	{
+		if (!(t > MIN_TEMPERATURE))
+			return MIN_TEMPERATURE;
+		if (!(t < MAX_TEMPERATURE))
+			return MAX_TEMPERATURE;
+		return (uint16_t)(t + 0.5);
+	}
+
+	uint16_t b;
+	double k;
+	double a_min;
+	double a_max;
+	double scale;
+	float table[SEGMENTS + 1];
+};
+
+#endif
@@ -0,0 +1,240 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        LC709203F_Watch.hpp
+ */
+
+#ifndef LC709203F_WATCH_HPP
+#define LC709203F_WATCH_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+#include "LC709203F.hpp"
+
+/* Derive from class LC709203F_Watch::Listener and implement the primed and changed functions! */
+
+/*
+ * LC709203F_Watch: change-notification subscriptions on top of LC709203F_Base.
+ * Consumers subscribe to a register with an optional deadband (in register units, e.g. 1 for
+ * +-1% RSOC or 10 for +-10 mV CELL_VOLTAGGE). Each call to poll() reads every watched register
+ * exactly once, regardless of the number of subscriptions on it, and calls a listener only when
+ * the value moved by more than its deadband since the last value delivered to that listener.
+ * The first value after subscribing is reported through primed() rather than changed(), so it
+ * cannot be mistaken for a change from 0 (e.g. STATUS_BIT I2C_MODE or RSOC 0%).
+ */
+class LC709203F_Watch
+{
+public:
+	/* Pure virtual functions that need to be implemented in derived class: */
+	class Listener
+	{
+	public:
+		virtual ~Listener() {}
+		virtual void primed(uint16_t address, uint16_t current) = 0;  // first value after subscribe
+		virtual void changed(uint16_t address, uint16_t previous, uint16_t current) = 0;
+	};
+
+	/*
+	 * Handle returned by subscribe(), used to unsubscribe. Carries the slot in the low 32 bits and the
+	 * slot's generation in the high 32 bits, so a stale handle never removes a reused slot.
+	 */
+	typedef uint64_t Handle;
+	static const Handle INVALID_HANDLE = ~(uint64_t)0;
+
+	explicit LC709203F_Watch(LC709203F_Base &device)
+		: device(device), polling(false)
+	{
+	}
+
+	/*
+	 * Subscribe listener to register address with width n (8 or 16 bit, as used by the
+	 * register's get function). The first poll() after subscribing always calls primed().
+	 * Subscriptions added from within a listener callback are first served by the next poll().
+	 */
+	Handle subscribe(uint16_t address, uint16_t n, Listener *listener, uint16_t deadband=0)
+	{
+		if (listener == 0)
+			return INVALID_HANDLE;
+
+		Subscription s;
+		s.register_index = watch(address, n);
+		s.listener = listener;
+		s.deadband = deadband;
+		s.last = 0;
+		s.primed = false;
+		s.active = true;
+		s.deferred = polling;
+		s.generation = 0;
+
+		for (size_t i = 0; i < subscriptions.size(); i++)
+		{
+			if (!subscriptions[i].active)
+			{
+				s.generation = subscriptions[i].generation + 1;
+				subscriptions[i] = s;
+				return makeHandle(i, s.generation);
+			}
+		}
+		subscriptions.push_back(s);
+		return makeHandle(subscriptions.size() - 1, s.generation);
+	}
+
+	/* Convenience subscriptions for the registers most consumers care about */
+	Handle subscribeRSOC(Listener *listener, uint16_t deadband=0)
+	{
+		return subscribe(LC709203F_Base::RSOC::__address, 8, listener, deadband);
+	}
+
+	Handle subscribeSTATUS_BIT(Listener *listener)
+	{
+		return subscribe(LC709203F_Base::STATUS_BIT::__address, 16, listener);
+	}
+
+	Handle subscribeIC_POWER_MODE(Listener *listener)
+	{
+		return subscribe(LC709203F_Base::IC_POWER_MODE::__address, 16, listener);
+	}
+
+	/*
+	 * CELL_VOLTAGGE is read as 16 bit, unlike the generated 8 bit getCELL_VOLTAGGE(): the register holds
+	 * the cell voltage in mV ('h0000 to 'hFFFF), and an 8 bit read wraps every 256 mV.
+	 */
+	Handle subscribeCELL_VOLTAGGE(Listener *listener, uint16_t deadband=0)
+	{
+		return subscribe(LC709203F_Base::CELL_VOLTAGGE::__address, 16, listener, deadband);
+	}
+
+	/* Remove a subscription; the register is no longer read once nobody watches it */
+	void unsubscribe(Handle handle)
+	{
+		size_t slot = (size_t)(handle & 0xffffffffu);
+		uint32_t generation = (uint32_t)(handle >> 32);
+		if (slot >= subscriptions.size() || !subscriptions[slot].active
+			|| subscriptions[slot].generation != generation)
+			return;
+
+		subscriptions[slot].active = false;
+		registers[subscriptions[slot].register_index].subscribers--;
+	}
+
+	/*
+	 * Read all watched registers once and notify listeners whose deadband was exceeded.
+	 * Returns the number of notifications delivered.
+	 */
+	size_t poll()
+	{
+		for (size_t i = 0; i < subscriptions.size(); i++)
+			subscriptions[i].deferred = false;
+
+		for (size_t i = 0; i < registers.size(); i++)
+		{
+			Register &r = registers[i];
+			if (r.subscribers == 0)
+				continue;
+			r.value = (r.n == 8) ? device.read8(r.address, 8) : device.read16(r.address, 16);
+		}
+
+		/* Listeners may subscribe from a callback; those registers were not read above */
+		polling = true;
+		size_t notified = 0;
+		for (size_t i = 0; i < subscriptions.size(); i++)
+		{
+			Subscription &s = subscriptions[i];
+			if (!s.active || s.deferred)
+				continue;
+
+			uint16_t address = registers[s.register_index].address;
+			uint16_t current = registers[s.register_index].value;
+			Listener *listener = s.listener;
+			if (!s.primed)
+			{
+				s.last = current;
+				s.primed = true;
+				listener->primed(address, current);
+				notified++;
+				continue;
+			}
+
+			uint16_t delta = (current > s.last) ? current - s.last : s.last - current;
+			if (delta <= s.deadband)
+				continue;
+
+			uint16_t previous = s.last;
+			s.last = current;
+			listener->changed(address, previous, current);
+			notified++;
+		}
+		polling = false;
+		return notified;
+	}
+
+	/* Number of distinct registers currently read by poll() */
+	size_t watchedRegisters() const
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < registers.size(); i++)
+			if (registers[i].subscribers != 0)
+				count++;
+		return count;
+	}
+
+private:
+	struct Register
+	{
+		uint16_t address;
+		uint16_t n;
+		uint16_t value;
+		size_t subscribers;
+	};
+
+	struct Subscription
+	{
+		size_t register_index;
+		Listener *listener;
+		uint16_t deadband;
+		uint16_t last;
+		bool primed;
+		bool active;
+		bool deferred;  // subscribed during poll(), served from the next poll()
+		uint32_t generation;
+	};
+
+	static Handle makeHandle(size_t slot, uint32_t generation)
+	{
+		return ((uint64_t)generation << 32) | (uint64_t)slot;
+	}
+
+	/* Find or add the shared read slot for a register */
+	size_t watch(uint16_t address, uint16_t n)
+	{
+		for (size_t i = 0; i < registers.size(); i++)
+		{
+			if (registers[i].address == address && registers[i].n == n)
+			{
+				registers[i].subscribers++;
+				return i;
+			}
+		}
+
+		Register r;
+		r.address = address;
+		r.n = n;
+		r.value = 0;
+		r.subscribers = 1;
+		registers.push_back(r);
+		return registers.size() - 1;
+	}
+
+	LC709203F_Base &device;
+	std::vector<Register> registers;
+	std::vector<Subscription> subscriptions;
+	bool polling;
+};
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        bench/LC709203F_PowerManager_check.cpp
+ */
+
+/*
+ * Check of LC709203F_PowerManager against a register array mock of LC709203F_Base.
+ * Build and run from the repository root:
+ *   g++ -I. bench/LC709203F_PowerManager_check.cpp -o powermanager_check && ./powermanager_check
+ * Exits non-zero if any check fails.
+ */
+
+#include <cstdio>
+#include "LC709203F.hpp"
+#include "LC709203F_PowerManager.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if (!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+static const uint16_t RSOC = LC709203F_Base::RSOC::__address;
+static const uint16_t VOLTAGE = LC709203F_Base::CELL_VOLTAGGE::__address;
+static const uint16_t POWER_MODE = LC709203F_Base::IC_POWER_MODE::__address;
+static const uint16_t OPERATIONAL = LC709203F_Base::IC_POWER_MODE::Operational_Mode;
+static const uint16_t SLEEP = LC709203F_Base::IC_POWER_MODE::Sleep_Mode;
+
+class MockDevice : public LC709203F_Base
+{
+public:
+	uint16_t reg[32];
+	int reads[32];
+	int mode_writes;
+
+	explicit MockDevice(uint16_t mode) : mode_writes(0)
+	{
+		for (int i = 0; i < 32; i++)
+		{
+			reg[i] = i;
+			reads[i] = 0;
+		}
+		reg[POWER_MODE] = mode;
+	}
+
+	uint8_t read8(uint16_t address, uint16_t) { reads[address]++; return (uint8_t)reg[address]; }
+	void write(uint16_t address, uint8_t value, uint16_t) { write(address, (uint16_t)value, 8); }
+	uint16_t read16(uint16_t address, uint16_t) { reads[address]++; return reg[address]; }
+	void write(uint16_t address, uint16_t value, uint16_t)
+	{
+		if (address == POWER_MODE)
+			mode_writes++;
+		reg[address] = value;
+	}
+};
+
+class Recorder : public LC709203F_PowerManager::Reader
+{
+public:
+	int count;
+	uint16_t value;
+
+	Recorder() : count(0), value(0) {}
+
+	void completed(uint16_t, uint16_t v) { count++; value = v; }
+};
+
+static void checkSyncedSleepingDevice()
+{
+	MockDevice device(SLEEP);
+	LC709203F_PowerManager manager(device);
+	CHECK(manager.isSleeping());
+
+	Recorder reader;
+	manager.queue(RSOC, 8, &reader, 0);
+	CHECK(manager.beginWindow(0));
+	CHECK(device.reg[POWER_MODE] == OPERATIONAL);
+	CHECK(manager.endWindow(0) == 1);
+	CHECK(reader.count == 1);
+	CHECK(device.reg[POWER_MODE] == SLEEP);
+}
+
+static void checkSettleTime()
+{
+	MockDevice device(SLEEP);
+	LC709203F_PowerManager manager(device);
+	manager.setSettle(100);
+
+	Recorder a, b, c;
+	manager.queue(RSOC, 8, &a, 0);
+	manager.queue(RSOC, 8, &b, 5);
+	manager.queue(VOLTAGE, 16, &c, 5);
+	CHECK(manager.beginWindow(10));
+	CHECK(!manager.windowReady(50));
+	CHECK(manager.endWindow(50) == 0);
+	CHECK(device.reads[RSOC] == 0);
+
+	CHECK(manager.endWindow(110) == 2);
+	CHECK(device.reads[RSOC] == 1 && device.reads[VOLTAGE] == 1);
+	CHECK(a.count == 1 && b.count == 1 && c.count == 1);
+	CHECK(manager.isSleeping());
+
+	const LC709203F_PowerManager::Metrics &metrics = manager.getMetrics();
+	CHECK(metrics.samples == 3);
+	CHECK(metrics.wake_windows == 1 && metrics.wake_max == 100);
+	CHECK(metrics.latency_max == 110);
+}
+
+static void checkUrgentReadWhileAsleep()
+{
+	MockDevice device(SLEEP);
+	LC709203F_PowerManager manager(device);
+	manager.setSettle(100);
+
+	Recorder a, b;
+	manager.queue(RSOC, 8, &a, 0);
+	manager.queue(RSOC, 8, &b, 0);
+	CHECK(manager.readNow(RSOC, 8, 10) == RSOC);
+	CHECK(device.mode_writes == 2 && manager.isSleeping());
+	CHECK(a.count == 0 && b.count == 0);
+	CHECK(manager.queued() == 2);
+
+	/* Inside a window that has not settled yet queued requests keep waiting as well */
+	CHECK(manager.beginWindow(20));
+	manager.readNow(RSOC, 8, 30);
+	CHECK(a.count == 0 && manager.queued() == 2);
+	CHECK(!manager.isSleeping());
+
+	/* Once settled the urgent value is shared instead of reading the register again */
+	manager.readNow(RSOC, 8, 120);
+	CHECK(a.count == 1 && b.count == 1 && manager.queued() == 0);
+	CHECK(device.reads[RSOC] == 3);
+	CHECK(manager.getMetrics().samples == 5);
+}
+
+static void checkUrgentReadWhileOperational()
+{
+	MockDevice device(OPERATIONAL);
+	LC709203F_PowerManager manager(device);
+	manager.setSettle(100);
+
+	Recorder a, b;
+	manager.queue(RSOC, 8, &a, 0);
+	manager.queue(VOLTAGE, 16, &b, 0);
+	manager.readNow(RSOC, 8, 10);
+	CHECK(device.reads[RSOC] == 1 && device.reads[VOLTAGE] == 1);
+	CHECK(a.count == 1 && b.count == 1);
+	CHECK(device.mode_writes == 0);
+}
+
+int main()
+{
+	checkSyncedSleepingDevice();
+	checkSettleTime();
+	checkUrgentReadWhileAsleep();
+	checkUrgentReadWhileOperational();
+
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures ? 1 : 0;
+}
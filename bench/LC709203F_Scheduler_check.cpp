@@ -0,0 +1,181 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        bench/LC709203F_Scheduler_check.cpp
+ */
+
+/*
+ * Check of LC709203F_Scheduler with a mock LC709203F_Base (Linux only, runs for about a second).
+ * Build and run from the repository root:
+ *   g++ -I. bench/LC709203F_Scheduler_check.cpp -o scheduler_check && ./scheduler_check
+ * Exits non-zero if any check fails.
+ */
+
+#include <cstdio>
+#include <vector>
+#include "LC709203F.hpp"
+#include "LC709203F_Scheduler.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if (!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+static const uint64_t MS = 1000000ull;
+
+class MockDevice : public LC709203F_Base
+{
+public:
+	int reads;
+
+	MockDevice() : reads(0) {}
+
+	uint8_t read8(uint16_t, uint16_t) { reads++; return 0; }
+	void write(uint16_t, uint8_t, uint16_t) {}
+	uint16_t read16(uint16_t, uint16_t) { reads++; return 0; }
+	void write(uint16_t, uint16_t, uint16_t) {}
+};
+
+class Recorder : public LC709203F_Scheduler::Dispatcher
+{
+public:
+	std::vector<uint16_t> buses;
+	std::vector<size_t> sizes;
+	std::vector<uint64_t> deadlines;
+	LC709203F_Scheduler *scheduler;
+	LC709203F_Scheduler::Handle remove_on_dispatch;
+
+	Recorder() : scheduler(0), remove_on_dispatch(LC709203F_Scheduler::INVALID_HANDLE) {}
+
+	void dispatch(uint16_t bus, const LC709203F_Scheduler::Due *due, size_t n)
+	{
+		buses.push_back(bus);
+		sizes.push_back(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			due[i].gauge->read16(LC709203F_Base::RSOC::__address, 16);
+			deadlines.push_back(due[i].deadline);
+		}
+		if (scheduler && remove_on_dispatch != LC709203F_Scheduler::INVALID_HANDLE)
+		{
+			scheduler->remove(remove_on_dispatch);
+			remove_on_dispatch = LC709203F_Scheduler::INVALID_HANDLE;
+		}
+	}
+};
+
+/* Run the loop until count dispatches happened or one second passed */
+static void runUntil(LC709203F_Scheduler &scheduler, Recorder &recorder, size_t count)
+{
+	uint64_t end = LC709203F_Scheduler::now() + 1000 * MS;
+	while (recorder.sizes.size() < count && LC709203F_Scheduler::now() < end)
+		CHECK(scheduler.runOnce(100) >= 0);
+}
+
+static void checkChurnKeepsHeapBounded()
+{
+	MockDevice device;
+	Recorder recorder;
+	LC709203F_Scheduler scheduler(recorder);
+	CHECK(scheduler.isOpen());
+
+	uint64_t hour = 3600000 * MS;
+	uint64_t start = LC709203F_Scheduler::now() + hour;
+	std::vector<LC709203F_Scheduler::Handle> handles;
+	for (size_t i = 0; i < 1000; i++)
+		handles.push_back(scheduler.add(&device, 0, hour, 0, start));
+
+	for (size_t round = 0; round < 100; round++)
+	{
+		for (size_t i = 0; i < handles.size(); i++)
+		{
+			scheduler.remove(handles[i]);
+			handles[i] = scheduler.add(&device, 0, hour, 0, start);
+		}
+	}
+	CHECK(scheduler.size() == 1000);
+	CHECK(scheduler.entries() <= 2 * scheduler.size() + 1);
+}
+
+static void checkStaleHandle()
+{
+	MockDevice device;
+	Recorder recorder;
+	LC709203F_Scheduler scheduler(recorder);
+
+	LC709203F_Scheduler::Handle stale = scheduler.add(&device, 0, 10 * MS);
+	scheduler.remove(stale);
+	scheduler.add(&device, 0, 10 * MS);
+	scheduler.remove(stale);
+	CHECK(scheduler.size() == 1);
+
+	runUntil(scheduler, recorder, 1);
+	CHECK(recorder.sizes.size() == 1);
+}
+
+static void checkCoalescingPerBus()
+{
+	MockDevice device;
+	Recorder recorder;
+	LC709203F_Scheduler scheduler(recorder, 2 * MS);
+
+	uint64_t start = LC709203F_Scheduler::now() + 20 * MS;
+	for (size_t i = 0; i < 6; i++)
+		scheduler.add(&device, (uint16_t)(i % 2), 1000 * MS, 0, start + (i % 3) * MS / 2);
+
+	runUntil(scheduler, recorder, 2);
+	CHECK(recorder.sizes.size() == 2);
+	CHECK(recorder.buses.size() == 2 && recorder.buses[0] == 0 && recorder.buses[1] == 1);
+	CHECK(recorder.sizes.size() == 2 && recorder.sizes[0] == 3 && recorder.sizes[1] == 3);
+	CHECK(device.reads == 6);
+	CHECK(scheduler.getMetrics().batches == 2 && scheduler.getMetrics().jobs == 6);
+}
+
+static void checkNoDrift()
+{
+	MockDevice device;
+	Recorder recorder;
+	LC709203F_Scheduler scheduler(recorder);
+
+	uint64_t start = LC709203F_Scheduler::now() + 5 * MS;
+	uint64_t interval = 7 * MS + 123;
+	scheduler.add(&device, 0, interval, 0, start);
+
+	runUntil(scheduler, recorder, 20);
+	CHECK(recorder.deadlines.size() == 20);
+	for (size_t i = 0; i < recorder.deadlines.size(); i++)
+		CHECK(recorder.deadlines[i] == start + i * interval);
+	CHECK(scheduler.getMetrics().missed == 0);
+}
+
+static void checkRemoveFromDispatcher()
+{
+	MockDevice device;
+	Recorder recorder;
+	LC709203F_Scheduler scheduler(recorder);
+	recorder.scheduler = &scheduler;
+
+	recorder.remove_on_dispatch = scheduler.add(&device, 0, 5 * MS);
+	runUntil(scheduler, recorder, 1);
+	CHECK(scheduler.size() == 0);
+	CHECK(scheduler.runOnce(30) == 0);
+	CHECK(recorder.sizes.size() == 1);
+	CHECK(scheduler.entries() == 0);
+}
+
+int main()
+{
+	checkChurnKeepsHeapBounded();
+	checkStaleHandle();
+	checkCoalescingPerBus();
+	checkNoDrift();
+	checkRemoveFromDispatcher();
+
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures ? 1 : 0;
+}
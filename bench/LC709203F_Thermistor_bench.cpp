@@ -0,0 +1,96 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        bench/LC709203F_Thermistor_bench.cpp
+ */
+
+/*
+ * Accuracy check and benchmark of LC709203F_Thermistor against the exact B-constant formula.
+ * Build and run from the repository root:
+ *   g++ -O2 -I. bench/LC709203F_Thermistor_bench.cpp -o thermistor_bench && ./thermistor_bench
+ * Exits non-zero if a table for a common B-constant and pullup deviates by more than ½ LSB (0.1K)
+ * from the exact formula, if an inaccurate table is accepted, or if a rounded batch result is off by
+ * more than 1 LSB.
+ */
+
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include "LC709203F_Thermistor.hpp"
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+	static const uint16_t b_constants[] = { 3380, 3435, 3950, 4250, 4500 };
+	static const double pullup_ratios[] = { 0.1, 1.0, 10.0, 100.0 };
+	static const size_t SAMPLES = 10000000;
+
+	int failed = 0;
+	for (size_t j = 0; j < sizeof(b_constants) / sizeof(b_constants[0]); j++)
+	{
+		for (size_t i = 0; i < sizeof(pullup_ratios) / sizeof(pullup_ratios[0]); i++)
+		{
+			LC709203F_Thermistor thermistor;
+			bool accepted = thermistor.setB(b_constants[j], pullup_ratios[i]);
+			double error = thermistor.maxError(100000);
+			printf("B=%u k=%g: %s, max error %.3f LSB\n", b_constants[j], pullup_ratios[i],
+				accepted ? "accepted" : "refused", error);
+			if (!accepted || error > LC709203F_Thermistor::maxTableError())
+				failed = 1;
+		}
+	}
+
+	/* Tables the interpolation cannot follow are refused and the previous table stays in place */
+	static const uint16_t too_steep[] = { 10000, 65535 };
+	for (size_t j = 0; j < sizeof(too_steep) / sizeof(too_steep[0]); j++)
+	{
+		LC709203F_Thermistor thermistor(3435);
+		bool accepted = thermistor.setB(too_steep[j]);
+		printf("B=%u k=1: %s\n", too_steep[j], accepted ? "accepted" : "refused");
+		if (accepted || thermistor.getB() != 3435 || thermistor.maxError() > LC709203F_Thermistor::maxTableError())
+			failed = 1;
+	}
+
+	/* Resistance ratios spanning the register range, -20°C (7.8) to +60°C (0.3) at B=3435 */
+	LC709203F_Thermistor thermistor(3435);
+	std::vector<double> ratios(SAMPLES);
+	std::vector<uint16_t> fast(SAMPLES);
+	std::vector<uint16_t> exact(SAMPLES);
+	for (size_t i = 0; i < SAMPLES; i++)
+		ratios[i] = 0.25 + 7.75 * i / SAMPLES;
+
+	clock_t start = clock();
+	thermistor.fromRatio(&ratios[0], &fast[0], SAMPLES);
+	double fast_s = seconds(start);
+
+	start = clock();
+	for (size_t i = 0; i < SAMPLES; i++)
+		exact[i] = thermistor.exactFromRatio(ratios[i]);
+	double exact_s = seconds(start);
+
+	uint16_t worst = 0;
+	for (size_t i = 0; i < SAMPLES; i++)
+	{
+		uint16_t error = (fast[i] > exact[i]) ? fast[i] - exact[i] : exact[i] - fast[i];
+		if (error > worst)
+			worst = error;
+	}
+	if (worst > 1)
+		failed = 1;
+
+	printf("%lu samples: table %.1f ns/sample, exact %.1f ns/sample, speedup %.2fx, max error %u LSB\n",
+		(unsigned long)SAMPLES, fast_s * 1e9 / SAMPLES, exact_s * 1e9 / SAMPLES,
+		fast_s > 0 ? exact_s / fast_s : 0.0, worst);
+
+	printf(failed ? "FAILED\n" : "OK\n");
+	return failed;
+}
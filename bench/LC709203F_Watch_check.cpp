@@ -0,0 +1,186 @@
+/*
+ * name:        LC709203F
+ * description: Smart LiB Gauge Battery Fuel Gauge LSI For 1‐Cell Lithium‐ion/Polymer (Li+)
+ * manuf:       ON Semiconductor
+ * version:     0.1
+ * url:         http://www.onsemi.com/pub/Collateral/LC709203F-D.PDF
+ * date:        2017-12-29
+ * author       https://chisl.io/
+ * file:        bench/LC709203F_Watch_check.cpp
+ */
+
+/*
+ * Check of LC709203F_Watch against a register array mock of LC709203F_Base.
+ * Build and run from the repository root:
+ *   g++ -I. bench/LC709203F_Watch_check.cpp -o watch_check && ./watch_check
+ * Exits non-zero if any check fails.
+ */
+
+#include <cstdio>
+#include "LC709203F.hpp"
+#include "LC709203F_Watch.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if (!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+class MockDevice : public LC709203F_Base
+{
+public:
+	uint16_t reg[32];
+	int reads;
+
+	MockDevice() : reads(0)
+	{
+		for (int i = 0; i < 32; i++)
+			reg[i] = 0;
+	}
+
+	uint8_t read8(uint16_t address, uint16_t) { reads++; return (uint8_t)reg[address]; }
+	void write(uint16_t address, uint8_t value, uint16_t) { reg[address] = value; }
+	uint16_t read16(uint16_t address, uint16_t) { reads++; return reg[address]; }
+	void write(uint16_t address, uint16_t value, uint16_t) { reg[address] = value; }
+};
+
+class Recorder : public LC709203F_Watch::Listener
+{
+public:
+	int primes;
+	int changes;
+	uint16_t address;
+	uint16_t previous;
+	uint16_t current;
+
+	Recorder() : primes(0), changes(0), address(0), previous(0), current(0) {}
+
+	void primed(uint16_t a, uint16_t c) { primes++; address = a; current = c; }
+	void changed(uint16_t a, uint16_t p, uint16_t c) { changes++; address = a; previous = p; current = c; }
+};
+
+/* Subscribes to CELL_VOLTAGGE from its first RSOC notification */
+class Subscriber : public Recorder
+{
+public:
+	LC709203F_Watch *watch;
+	Recorder voltage;
+
+	Subscriber() : watch(0) {}
+
+	void primed(uint16_t a, uint16_t c)
+	{
+		Recorder::primed(a, c);
+		watch->subscribeCELL_VOLTAGGE(&voltage);
+	}
+};
+
+static void checkSharedReadAndDeadband()
+{
+	MockDevice device;
+	LC709203F_Watch watch(device);
+	Recorder fine, coarse;
+	watch.subscribeRSOC(&fine);
+	watch.subscribeRSOC(&coarse, 1);
+
+	device.reg[LC709203F_Base::RSOC::__address] = 50;
+	watch.poll();
+	CHECK(device.reads == 1);
+	CHECK(fine.primes == 1 && coarse.primes == 1);
+	CHECK(fine.changes == 0 && coarse.changes == 0);
+
+	device.reg[LC709203F_Base::RSOC::__address] = 51;
+	watch.poll();
+	CHECK(fine.changes == 1 && coarse.changes == 0);
+
+	device.reg[LC709203F_Base::RSOC::__address] = 52;
+	watch.poll();
+	CHECK(fine.changes == 2 && coarse.changes == 1);
+	CHECK(coarse.previous == 50 && coarse.current == 52);
+	CHECK(device.reads == 3);
+}
+
+static void checkPrimingOfZero()
+{
+	MockDevice device;
+	LC709203F_Watch watch(device);
+	Recorder status;
+	watch.subscribeSTATUS_BIT(&status);
+
+	watch.poll();
+	CHECK(status.primes == 1 && status.changes == 0 && status.current == LC709203F_Base::STATUS_BIT::I2C_MODE);
+
+	device.reg[LC709203F_Base::STATUS_BIT::__address] = LC709203F_Base::STATUS_BIT::THERMISTOR_MODE;
+	watch.poll();
+	CHECK(status.changes == 1 && status.previous == LC709203F_Base::STATUS_BIT::I2C_MODE);
+}
+
+static void checkVoltageWidth()
+{
+	MockDevice device;
+	LC709203F_Watch watch(device);
+	Recorder voltage;
+	watch.subscribeCELL_VOLTAGGE(&voltage, 10);
+
+	device.reg[LC709203F_Base::CELL_VOLTAGGE::__address] = 3800;
+	watch.poll();
+	CHECK(voltage.current == 3800);
+
+	device.reg[LC709203F_Base::CELL_VOLTAGGE::__address] = 4056;
+	watch.poll();
+	CHECK(voltage.changes == 1 && voltage.current == 4056);
+
+	device.reg[LC709203F_Base::CELL_VOLTAGGE::__address] = 4060;
+	watch.poll();
+	CHECK(voltage.changes == 1);
+}
+
+static void checkReentrantSubscribe()
+{
+	MockDevice device;
+	LC709203F_Watch watch(device);
+	Recorder spare;
+	Subscriber subscriber;
+	subscriber.watch = &watch;
+
+	/* Leave a free slot behind the subscriber that the callback's subscription reuses */
+	watch.subscribeRSOC(&subscriber);
+	watch.unsubscribe(watch.subscribeRSOC(&spare));
+
+	device.reg[LC709203F_Base::RSOC::__address] = 40;
+	device.reg[LC709203F_Base::CELL_VOLTAGGE::__address] = 3700;
+	watch.poll();
+	CHECK(subscriber.primes == 1);
+	CHECK(subscriber.voltage.primes == 0 && subscriber.voltage.changes == 0);
+
+	watch.poll();
+	CHECK(subscriber.voltage.primes == 1 && subscriber.voltage.current == 3700);
+	CHECK(subscriber.voltage.changes == 0);
+}
+
+static void checkStaleHandle()
+{
+	MockDevice device;
+	LC709203F_Watch watch(device);
+	Recorder first, second;
+
+	LC709203F_Watch::Handle stale = watch.subscribeRSOC(&first);
+	watch.unsubscribe(stale);
+	watch.subscribeRSOC(&second);
+	watch.unsubscribe(stale);
+
+	watch.poll();
+	CHECK(first.primes == 0 && second.primes == 1);
+	CHECK(watch.watchedRegisters() == 1);
+}
+
+int main()
+{
+	checkSharedReadAndDeadband();
+	checkPrimingOfZero();
+	checkVoltageWidth();
+	checkReentrantSubscribe();
+	checkStaleHandle();
+
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures ? 1 : 0;
+}